@@ -1,37 +1,116 @@
+#include <charconv>
 #include <iostream>
 #include <fstream>
+#include <string_view>
+#include <thread>
 
+#include <profiler.h>
 #include <token.h>
 #include <tokenizer.h>
 
+static void print_usage(const char* program_name) {
+    std::cerr << "usage: " << program_name << " [options] <input file>" << std::endl
+              << "options:" << std::endl
+              << "   --time-phases            print time and memory statistics of each compilation phase" << std::endl
+              << "   --trace=<file>           write chrome trace-event json of compilation phases to <file>" << std::endl
+              << "   --tokenizer-threads=<n>  tokenize the input on <n> threads (0 - one per hardware thread)" << std::endl;
+}
+
 int main(int argc, char** argv) {
-    if(argc < 2) {
-        std::cerr << "usage: " << argv[0] << " <input file>" << std::endl;
-        return 1;
+    bool time_phases = false;
+    std::string trace_output_path {};
+    std::string input_file_path {};
+    slof::usz tokenizer_thread_count = 1;
+
+    for(int i = 1; i < argc; i++) {
+        std::string_view argument { argv[i] };
+        if(argument == "--time-phases") {
+            time_phases = true;
+        } else if(argument.starts_with("--trace=")) {
+            trace_output_path = argument.substr(std::string_view("--trace=").length());
+            if(trace_output_path.empty()) {
+                std::cerr << "error: --trace requires an output file path" << std::endl;
+                return 1;
+            }
+        } else if(argument.starts_with("--tokenizer-threads=")) {
+            auto thread_count_string = argument.substr(std::string_view("--tokenizer-threads=").length());
+            auto thread_count_string_end = thread_count_string.data() + thread_count_string.length();
+            auto [parse_end, parse_error] = std::from_chars(thread_count_string.data(), thread_count_string_end, tokenizer_thread_count);
+            if(parse_error != std::errc {} || parse_end != thread_count_string_end) {
+                std::cerr << "error: invalid tokenizer thread count '" << thread_count_string << "'" << std::endl;
+                return 1;
+            }
+            if(tokenizer_thread_count == 0)
+                tokenizer_thread_count = std::max(1u, std::thread::hardware_concurrency());
+        } else if(argument.starts_with("--")) {
+            std::cerr << "error: unknown option '" << argument << "'" << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        } else if(input_file_path.empty()) {
+            input_file_path = argument;
+        } else {
+            std::cerr << "error: only one input file can be provided" << std::endl;
+            return 1;
+        }
     }
 
-    std::string input_file_path { argv[1] };
-    std::ifstream input_file { input_file_path };
-    if(!input_file) {
-        std::cerr << "error: could not open file '" << input_file_path << "' for reading" << std::endl;
-        return 1;  
+    if(input_file_path.empty()) {
+        print_usage(argv[0]);
+        return 1;
     }
 
-    std::string input_file_contents { 
-        std::istreambuf_iterator<slof::c8>(input_file), 
-        std::istreambuf_iterator<slof::c8>() 
-    };
+    if(time_phases || !trace_output_path.empty())
+        slof::Profiler::enable();
+
+    auto exit_code = [&]() {
+        slof::Profiler::ScopedPhase compilation_phase { "compile" };
+
+        std::string input_file_contents {};
+        {
+            slof::Profiler::ScopedPhase reading_phase { "read input" };
+            std::ifstream input_file { input_file_path };
+            if(!input_file) {
+                std::cerr << "error: could not open file '" << input_file_path << "' for reading" << std::endl;
+                return 1;
+            }
+
+            input_file_contents = std::string {
+                std::istreambuf_iterator<slof::c8>(input_file),
+                std::istreambuf_iterator<slof::c8>()
+            };
+            reading_phase.set_item_count(input_file_contents.length());
+        }
+
+        auto tokenization_result = [&]() {
+            slof::Profiler::ScopedPhase tokenizing_phase { "tokenize" };
+            auto result = tokenizer_thread_count > 1
+                ? slof::Tokenizer::tokenize_parallel(input_file_contents, tokenizer_thread_count)
+                : slof::Tokenizer::tokenize(input_file_contents);
+            if(result.is_token_stream())
+                tokenizing_phase.set_item_count(result.token_stream().remaining_items());
+            return result;
+        }();
+        if(tokenization_result.is_error()) {
+            std::cout << "error (tokenizer): " << tokenization_result.error_message() << std::endl;
+            return 0;
+        }
 
-    auto tokenization_result = slof::Tokenizer::tokenize(input_file_contents);
-    if(tokenization_result.is_error()) {
-        std::cout << "error (tokenizer): " << tokenization_result.error_message() << std::endl;
-    } else {
         auto& token_stream = tokenization_result.token_stream();
+        slof::Profiler::ScopedPhase printing_phase { "print tokens" };
+        printing_phase.set_item_count(token_stream.remaining_items());
         std::cout << "Token list (" << token_stream.remaining_items() << " items)" << std::endl;
         while(!token_stream.eos()) {
             std::cout << "   - " << token_stream.consume_unchecked() << std::endl;
         }
+        return 0;
+    }();
+
+    if(time_phases)
+        slof::Profiler::print_summary(std::cerr);
+    if(!trace_output_path.empty() && !slof::Profiler::write_chrome_trace(trace_output_path)) {
+        std::cerr << "error: could not write trace to '" << trace_output_path << "'" << std::endl;
+        return 1;
     }
 
-    return 0;
-}
\ No newline at end of file
+    return exit_code;
+}
@@ -0,0 +1,239 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <algorithm>
+
+#include <profiler.h>
+
+namespace slof {
+
+static std::atomic<usz> s_allocation_count { 0 };
+static std::atomic<usz> s_allocated_bytes { 0 };
+static std::atomic<usz> s_live_bytes { 0 };
+static std::atomic<usz> s_peak_bytes { 0 };
+
+bool Profiler::s_enabled { false };
+u32 Profiler::s_current_depth { 0 };
+std::chrono::steady_clock::time_point Profiler::s_epoch {};
+std::vector<Profiler::PhaseRecord> Profiler::s_phase_records {};
+
+#ifdef SLOF_ENABLE_ALLOCATION_TRACKING
+
+// every allocation is prefixed with a header holding the size that was added to the
+// counters (0 if the block was allocated before profiling was enabled), the header
+// is max_align_t sized so that the returned pointer keeps the alignment guarantees
+static constexpr usz s_allocation_header_size = alignof(std::max_align_t);
+
+static void* tracked_allocate(usz size) {
+    auto* block = static_cast<u8*>(std::malloc(size + s_allocation_header_size));
+    if(block == nullptr)
+        return nullptr;
+
+    auto counted = Profiler::is_enabled();
+    *reinterpret_cast<usz*>(block) = counted ? size : 0;
+    if(counted) {
+        s_allocation_count.fetch_add(1, std::memory_order_relaxed);
+        s_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        auto live_bytes = s_live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        auto peak_bytes = s_peak_bytes.load(std::memory_order_relaxed);
+        while(live_bytes > peak_bytes && !s_peak_bytes.compare_exchange_weak(peak_bytes, live_bytes, std::memory_order_relaxed)) {}
+    }
+    return block + s_allocation_header_size;
+}
+
+static void tracked_free(void* pointer) {
+    if(pointer == nullptr)
+        return;
+    auto* block = static_cast<u8*>(pointer) - s_allocation_header_size;
+    auto counted_size = *reinterpret_cast<usz*>(block);
+    if(counted_size != 0)
+        s_live_bytes.fetch_sub(counted_size, std::memory_order_relaxed);
+    std::free(block);
+}
+
+bool Profiler::is_tracking_allocations() { return true; }
+
+#else
+
+bool Profiler::is_tracking_allocations() { return false; }
+
+#endif
+
+void Profiler::enable() {
+    if(s_enabled)
+        return;
+    s_epoch = std::chrono::steady_clock::now();
+    s_enabled = true;
+}
+
+void Profiler::ScopedPhase::begin(const c8* name) {
+    m_active = true;
+    m_name = name;
+    m_allocation_count_at_start = s_allocation_count.load(std::memory_order_relaxed);
+    m_allocated_bytes_at_start = s_allocated_bytes.load(std::memory_order_relaxed);
+    m_live_bytes_at_start = s_live_bytes.load(std::memory_order_relaxed);
+    // peak is measured per phase, so the outer phase's peak is saved and merged back in end()
+    m_outer_peak_bytes = s_peak_bytes.exchange(m_live_bytes_at_start, std::memory_order_relaxed);
+    Profiler::s_current_depth++;
+    m_start = std::chrono::steady_clock::now();
+}
+
+void Profiler::ScopedPhase::end() {
+    auto end = std::chrono::steady_clock::now();
+    Profiler::s_current_depth--;
+
+    auto peak_bytes = s_peak_bytes.load(std::memory_order_relaxed);
+    s_peak_bytes.store(std::max(peak_bytes, m_outer_peak_bytes), std::memory_order_relaxed);
+
+    PhaseRecord record {};
+    record.name = m_name;
+    record.depth = Profiler::s_current_depth;
+    record.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(m_start - Profiler::s_epoch).count();
+    record.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_start).count();
+    record.item_count = m_item_count;
+    record.allocation_count = s_allocation_count.load(std::memory_order_relaxed) - m_allocation_count_at_start;
+    record.allocated_bytes = s_allocated_bytes.load(std::memory_order_relaxed) - m_allocated_bytes_at_start;
+    record.peak_bytes = peak_bytes - std::min(peak_bytes, m_live_bytes_at_start);
+    for(auto const& [counter_name, counter_value] : m_counters)
+        record.counters.emplace_back(counter_name, counter_value);
+    Profiler::s_phase_records.push_back(std::move(record));
+}
+
+static std::vector<Profiler::PhaseRecord> phase_records_in_start_order() {
+    // phases are recorded when they end, so nested phases come before their parents;
+    // a parent and its child can share a start timestamp, so ties are broken by depth
+    auto records = Profiler::phase_records();
+    std::stable_sort(records.begin(), records.end(), [](const auto& left, const auto& right) {
+        if(left.start_ns != right.start_ns)
+            return left.start_ns < right.start_ns;
+        return left.depth < right.depth;
+    });
+    return records;
+}
+
+void Profiler::print_summary(std::ostream& stream) {
+    auto tracking = is_tracking_allocations();
+    auto format_bytes_column = [&](usz value) { return tracking ? std::to_string(value) : std::string("-"); };
+    // the table changes alignment and float formatting, so restore the caller's stream state afterwards
+    auto saved_flags = stream.flags();
+    auto saved_precision = stream.precision();
+
+    stream << std::left << std::setw(24) << "phase"
+           << std::right << std::setw(12) << "time (ms)"
+           << std::setw(12) << "items"
+           << std::setw(14) << "allocations"
+           << std::setw(16) << "allocated (B)"
+           << std::setw(14) << "peak (B)" << std::endl;
+
+    for(auto const& record : phase_records_in_start_order()) {
+        std::string indented_name = std::string(record.depth * 2, ' ') + record.name;
+        stream << std::left << std::setw(24) << indented_name
+               << std::right << std::setw(12) << std::fixed << std::setprecision(3) << (record.duration_ns / 1e6)
+               << std::setw(12) << record.item_count
+               << std::setw(14) << format_bytes_column(record.allocation_count)
+               << std::setw(16) << format_bytes_column(record.allocated_bytes)
+               << std::setw(14) << format_bytes_column(record.peak_bytes);
+        for(auto const& [counter_name, counter_value] : record.counters)
+            stream << "  " << counter_name << "=" << counter_value;
+        stream << std::endl;
+    }
+
+    stream.flags(saved_flags);
+    stream.precision(saved_precision);
+
+    if(!tracking)
+        stream << "note: allocation tracking is disabled, rebuild with SLOF_ENABLE_ALLOCATION_TRACKING=ON to enable it" << std::endl;
+}
+
+static std::string escape_json_string(const std::string& string) {
+    std::string result {};
+    for(auto character : string) {
+        if(character == '"' || character == '\\')
+            result += '\\';
+        result += character;
+    }
+    return result;
+}
+
+bool Profiler::write_chrome_trace(const std::string& output_file_path) {
+    std::ofstream output_file { output_file_path };
+    if(!output_file)
+        return false;
+
+    // chrome trace-event format expects timestamps and durations in microseconds
+    output_file << "{\"traceEvents\":[";
+    auto records = phase_records_in_start_order();
+    for(usz i = 0; i < records.size(); i++) {
+        auto const& record = records[i];
+        output_file << (i == 0 ? "\n" : ",\n")
+                    << "{\"name\":\"" << escape_json_string(record.name) << "\",\"cat\":\"phase\",\"ph\":\"X\""
+                    << ",\"ts\":" << std::fixed << std::setprecision(3) << (record.start_ns / 1e3)
+                    << ",\"dur\":" << (record.duration_ns / 1e3)
+                    << ",\"pid\":1,\"tid\":1,\"args\":{\"items\":" << record.item_count;
+        if(is_tracking_allocations()) {
+            output_file << ",\"allocations\":" << record.allocation_count
+                        << ",\"allocated_bytes\":" << record.allocated_bytes
+                        << ",\"peak_bytes\":" << record.peak_bytes;
+        }
+        for(auto const& [counter_name, counter_value] : record.counters)
+            output_file << ",\"" << escape_json_string(counter_name) << "\":" << counter_value;
+        output_file << "}}";
+    }
+    output_file << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+    return static_cast<bool>(output_file);
+}
+
+} // namespace slof
+
+#ifdef SLOF_ENABLE_ALLOCATION_TRACKING
+
+// NOTE: every replaceable non-aligned form of new/delete is replaced, so that no block
+//       without a tracking header can ever reach tracked_free(); aligned forms are left
+//       to the standard library, as they are always paired with their own deletes
+void* operator new(std::size_t size) {
+    auto* pointer = slof::tracked_allocate(size);
+    if(pointer == nullptr)
+        throw std::bad_alloc {};
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return slof::tracked_allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return slof::tracked_allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    slof::tracked_free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    slof::tracked_free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    slof::tracked_free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    slof::tracked_free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    slof::tracked_free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    slof::tracked_free(pointer);
+}
+
+#endif
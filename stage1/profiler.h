@@ -0,0 +1,85 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <utility>
+#include <chrono>
+#include <iostream>
+
+#include <types.h>
+
+namespace slof {
+
+// NOTE: phase timing is always compiled in, but it is only a single branch per
+//       phase when profiling is not enabled at runtime; allocation tracking replaces
+//       global operator new/delete and therefore is only compiled in when the
+//       SLOF_ENABLE_ALLOCATION_TRACKING option is turned on
+class Profiler {
+public:
+    struct PhaseRecord {
+        std::string name {};
+        u32 depth { 0 };
+        u64 start_ns { 0 };
+        u64 duration_ns { 0 };
+        usz item_count { 0 };
+        usz allocation_count { 0 };
+        usz allocated_bytes { 0 };
+        usz peak_bytes { 0 };
+        std::vector<std::pair<std::string, usz>> counters {};
+    };
+
+    class ScopedPhase {
+    public:
+        explicit ScopedPhase(const c8* name) {
+            if(Profiler::is_enabled())
+                begin(name);
+        }
+
+        ~ScopedPhase() {
+            if(m_active)
+                end();
+        }
+
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+        void set_item_count(usz item_count) { m_item_count = item_count; }
+        // phase specific statistics, printed after the standard columns and added to trace args
+        void add_counter(const c8* name, usz value) {
+            if(m_active)
+                m_counters.emplace_back(name, value);
+        }
+
+    private:
+        void begin(const c8* name);
+        void end();
+
+        bool m_active { false };
+        const c8* m_name { nullptr };
+        std::chrono::steady_clock::time_point m_start {};
+        usz m_item_count { 0 };
+        usz m_allocation_count_at_start { 0 };
+        usz m_allocated_bytes_at_start { 0 };
+        usz m_live_bytes_at_start { 0 };
+        usz m_outer_peak_bytes { 0 };
+        std::vector<std::pair<const c8*, usz>> m_counters {};
+
+    };
+
+    static void enable();
+    static bool is_enabled() { return s_enabled; }
+    static bool is_tracking_allocations();
+
+    static const std::vector<PhaseRecord>& phase_records() { return s_phase_records; }
+
+    static void print_summary(std::ostream& stream);
+    static bool write_chrome_trace(const std::string& output_file_path);
+
+private:
+    static bool s_enabled;
+    static u32 s_current_depth;
+    static std::chrono::steady_clock::time_point s_epoch;
+    static std::vector<PhaseRecord> s_phase_records;
+
+};
+
+} // namespace slof
@@ -1,25 +1,50 @@
 #include <algorithm>
+#include <array>
 
 #include <token.h>
 
 namespace slof {
 
-static std::string string_to_lower(std::string string) {
-    auto to_lower = [](c8 c) { return (c >= 'A' && c <='Z') ? c + ('a' - 'A') : c; };
-    std::transform(string.begin(), string.end(), string.begin(), to_lower);
-    return string;
-}
+// keyword literals are derived from keyword token type names ("FuncKeyword" -> "func"),
+// this is done at compile time so no table has to be constructed on startup
+struct KeywordLiteral {
+    std::array<c8, 16> characters {};
+    usz length { 0 };
+    TokenType type { TokenType::Invalid };
+
+    constexpr std::string_view view() const { return { characters.data(), length }; }
+};
 
-static std::string keyword_type_literal_to_keyword_literal(std::string keyword_type_literal) {
-    return string_to_lower(keyword_type_literal.substr(0, keyword_type_literal.find("Keyword")));
+static consteval KeywordLiteral keyword_type_literal_to_keyword_literal(std::string_view keyword_type_literal, TokenType type) {
+    KeywordLiteral result {};
+    auto keyword_literal = keyword_type_literal.substr(0, keyword_type_literal.find("Keyword"));
+    for(auto c : keyword_literal)
+        result.characters[result.length++] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+    result.type = type;
+    return result;
 }
 
-std::unordered_map<std::string, TokenType> Token::s_keyword_literal_to_keyword_type = {
-    #define TOKEN_ENUMERATOR(x) \
-        { keyword_type_literal_to_keyword_literal(#x), TokenType::x },
-    ENUMERATE_SLOF_KEYWORD_TOKEN_TYPES
-    #undef TOKEN_ENUMERATOR
-};
+static constexpr auto s_keyword_literals = []() {
+    std::array keyword_literals {
+        #define TOKEN_ENUMERATOR(x) \
+            keyword_type_literal_to_keyword_literal(#x, TokenType::x),
+        ENUMERATE_SLOF_KEYWORD_TOKEN_TYPES
+        #undef TOKEN_ENUMERATOR
+    };
+    std::sort(keyword_literals.begin(), keyword_literals.end(), [](const auto& left, const auto& right) {
+        return left.view() < right.view();
+    });
+    return keyword_literals;
+}();
+
+std::optional<TokenType> Token::keyword_type_from_literal(std::string_view literal) {
+    auto keyword = std::lower_bound(s_keyword_literals.begin(), s_keyword_literals.end(), literal, [](const auto& keyword, std::string_view literal) {
+        return keyword.view() < literal;
+    });
+    if(keyword == s_keyword_literals.end() || keyword->view() != literal)
+        return {};
+    return keyword->type;
+}
 
 std::string Token::stringify_literal() const {
     if(!has_literal())
@@ -1,8 +1,9 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <optional>
 #include <iostream>
 #include <variant>
-#include <unordered_map>
 
 #include <types.h>
 
@@ -103,6 +104,10 @@
     TOKEN_ENUMERATOR(IntegerLiteral) \
     TOKEN_ENUMERATOR(FloatLiteral) \
     TOKEN_ENUMERATOR(StringLiteral) \
+    TOKEN_ENUMERATOR(FormatStringBegin) \
+    TOKEN_ENUMERATOR(FormatStringInterpolationBegin) \
+    TOKEN_ENUMERATOR(FormatStringInterpolationEnd) \
+    TOKEN_ENUMERATOR(FormatStringEnd) \
     TOKEN_ENUMERATOR(Invalid)
 
 namespace slof  {
@@ -117,7 +122,8 @@ class Token {
 public:
     using literal_variant = std::variant<std::monostate, bool, u64, f64, std::string>;
 
-    static std::unordered_map<std::string, TokenType> s_keyword_literal_to_keyword_type;
+    // keyword lookup table is built at compile time, see token.cpp
+    static std::optional<TokenType> keyword_type_from_literal(std::string_view literal);
 
     explicit Token(TokenType type) : m_type(type) {}
     Token(TokenType type, literal_variant literal) : m_type(type), m_literal(literal) {}
@@ -1,18 +1,23 @@
+#include <algorithm>
+#include <iterator>
 #include <string>
 #include <sstream>
+#include <system_error>
+#include <thread>
 
 #include <ctype.h>
 
+#include <profiler.h>
 #include <tokenizer.h>
 
 namespace slof {
 
 bool Tokenizer::InputStream::eos() const {
-    return m_stream_position == m_string.length();
+    return m_stream_position == m_end;
 }
 
 usz Tokenizer::InputStream::remaining_items() const {
-    return m_string.length() - m_stream_position;
+    return m_end - m_stream_position;
 }
 
 const c8* Tokenizer::InputStream::peek(usz offset) const {
@@ -74,14 +79,113 @@ std::optional<Token> Tokenizer::TokenStream::consume_if(element_predicate predic
 }
 
 Tokenizer::TokenizationResult Tokenizer::tokenize(std::string text_to_tokenize) {
-    InputStream input_stream { text_to_tokenize };
+    auto result = tokenize_chunk(text_to_tokenize, 0, text_to_tokenize.length(), text_to_tokenize.length());
+    if(result.error_message.has_value())
+        return std::move(*result.error_message);
+    return TokenStream(std::move(result.tokens));
+}
+
+Tokenizer::TokenizationResult Tokenizer::tokenize_parallel(const std::string& text_to_tokenize, usz thread_count) {
+    auto text_length = text_to_tokenize.length();
+    thread_count = std::min({ thread_count, s_maximal_parallel_thread_count, text_length / s_minimal_parallel_chunk_size });
+    if(thread_count <= 1)
+        return tokenize(text_to_tokenize);
+
+    // chunk boundaries are placed right after a new line character, so the only token that 
+    // can cross them is a string literal (comments end with, and consume, the new line)
+    std::vector<usz> chunk_boundaries { 0 };
+    for(usz i = 1; i < thread_count; i++) {
+        auto new_line_position = text_to_tokenize.find('\n', i * (text_length / thread_count));
+        if(new_line_position == std::string::npos)
+            break;
+        if(new_line_position + 1 > chunk_boundaries.back())
+            chunk_boundaries.push_back(new_line_position + 1);
+    }
+    if(chunk_boundaries.back() != text_length)
+        chunk_boundaries.push_back(text_length);
+    auto chunk_count = chunk_boundaries.size() - 1;
+
+    std::vector<ChunkTokenizationResult> speculative_results(chunk_count);
+    {
+        Profiler::ScopedPhase lexing_phase { "lex chunks" };
+        auto lex_chunk = [&](usz chunk_index) {
+            auto chunk_begin = chunk_boundaries[chunk_index];
+            auto chunk_end = chunk_boundaries[chunk_index + 1];
+            speculative_results[chunk_index] = tokenize_chunk(text_to_tokenize, chunk_begin, chunk_end, chunk_end);
+        };
+
+        std::vector<std::thread> threads {};
+        threads.reserve(chunk_count);
+        usz started_chunk_count = 0;
+        try {
+            for(; started_chunk_count < chunk_count; started_chunk_count++)
+                threads.emplace_back(lex_chunk, started_chunk_count);
+        } catch(const std::system_error&) {
+            // no more threads could be started, so the remaining chunks are lexed on this one
+        }
+        for(usz i = started_chunk_count; i < chunk_count; i++)
+            lex_chunk(i);
+        for(auto& thread : threads)
+            thread.join();
+
+        usz speculative_token_count = 0;
+        for(auto const& result : speculative_results)
+            speculative_token_count += result.tokens.size();
+        lexing_phase.set_item_count(speculative_token_count);
+        lexing_phase.add_counter("chunks", chunk_count);
+        lexing_phase.add_counter("threads", threads.size());
+    }
+
+    // walk the chunks in order, keeping the position up to which the input is known to be tokenized
+    // correctly; a speculative result is only valid if the chunk starts exactly at that position
+    // and its lexing did not run into the end of the chunk in the middle of a token (which is reported
+    // as an error), otherwise the chunk is lexed again serially from the current position
+    Profiler::ScopedPhase stitching_phase { "stitch chunks" };
     std::vector<Token> result_tokens {};
+    usz total_token_count = 0;
+    for(auto const& result : speculative_results)
+        total_token_count += result.tokens.size();
+    result_tokens.reserve(total_token_count);
+
+    usz position = 0;
+    usz relexed_chunk_count = 0;
+    for(usz i = 0; i < chunk_count; i++) {
+        auto chunk_end = chunk_boundaries[i + 1];
+        if(position >= chunk_end)
+            continue;
+
+        auto& speculative_result = speculative_results[i];
+        if(position == chunk_boundaries[i] && !speculative_result.error_message.has_value()) {
+            std::move(speculative_result.tokens.begin(), speculative_result.tokens.end(), std::back_inserter(result_tokens));
+            position = speculative_result.end_position;
+            continue;
+        }
 
-    while(!input_stream.eos()) {
+        relexed_chunk_count++;
+        auto result = tokenize_chunk(text_to_tokenize, position, text_length, chunk_end);
+        if(result.error_message.has_value())
+            return std::move(*result.error_message);
+        std::move(result.tokens.begin(), result.tokens.end(), std::back_inserter(result_tokens));
+        position = result.end_position;
+    }
+    stitching_phase.set_item_count(result_tokens.size());
+    stitching_phase.add_counter("relexed_chunks", relexed_chunk_count);
+
+    return TokenStream(std::move(result_tokens));
+}
+
+Tokenizer::ChunkTokenizationResult Tokenizer::tokenize_chunk(const std::string& text, usz begin, usz end, usz stop_at) {
+    InputStream input_stream { text, begin, end };
+    ChunkTokenizationResult result {};
+    auto& result_tokens = result.tokens;
+
+    while(!input_stream.eos() && input_stream.position() < stop_at) {
         auto& current = *input_stream.peek();
 
         if(std::isspace(current)) {
             input_stream.consume_unchecked();
+        } else if(current == 'f' && input_stream.peek(1) != nullptr && *input_stream.peek(1) == '"') {
+            consume_format_string(input_stream, result_tokens);
         } else if(current == '_' || std::isalpha(current)) {
             result_tokens.push_back(consume_identifier_or_keyword(input_stream));
         } else if(std::isdigit(current)) {
@@ -98,8 +202,10 @@ Tokenizer::TokenizationResult Tokenizer::tokenize(std::string text_to_tokenize)
         // and at the same time remove added comments
         if(result_tokens.size() > 0) {
             auto& last_token = result_tokens[result_tokens.size() - 1];
-            if(last_token.type() == TokenType::Invalid)
-                return last_token.string_literal();
+            if(last_token.type() == TokenType::Invalid) {
+                result.error_message = last_token.string_literal();
+                break;
+            }
 
             // if last added token was comment, remove it
             if(last_token.type() == TokenType::Comment)
@@ -107,7 +213,8 @@ Tokenizer::TokenizationResult Tokenizer::tokenize(std::string text_to_tokenize)
         }
     }
 
-    return TokenStream(std::move(result_tokens));
+    result.end_position = input_stream.position();
+    return result;
 }
 
 std::string Tokenizer::consume_until(consume_predicate predicate, InputStream& input_stream) {
@@ -129,8 +236,8 @@ Token Tokenizer::consume_identifier_or_keyword(InputStream& input_stream) {
     };
     auto identifier = consume_until(identifier_predicate, input_stream);
 
-    if(Token::s_keyword_literal_to_keyword_type.contains(identifier))
-        return Token { Token::s_keyword_literal_to_keyword_type.at(identifier) };
+    if(auto keyword_type = Token::keyword_type_from_literal(identifier); keyword_type.has_value())
+        return Token { *keyword_type };
     return Token { TokenType::Identifier, std::move(identifier) };
 }
 
@@ -187,6 +294,113 @@ Token Tokenizer::consume_string(InputStream& input_stream) {
     return Token { TokenType::StringLiteral, std::move(string_contents) };
 }
 
+// format string literals (f"...") are split already during tokenization, so that later stages
+// never have to parse the format string; f"a{x}b" becomes:
+//   FormatStringBegin(literal=2), StringLiteral("a"), FormatStringInterpolationBegin, 
+//   <tokens of x>, FormatStringInterpolationEnd, StringLiteral("b"), FormatStringEnd
+// the literal of FormatStringBegin is the total length of all literal segments, which is the lower
+// bound for the size of the formatted string; '{{' and '}}' are used to write literal braces
+void Tokenizer::consume_format_string(InputStream& input_stream, std::vector<Token>& result_tokens) {
+    input_stream.consume_unchecked(); // consume 'f' prefix
+    input_stream.consume_unchecked(); // consume opening '"'
+
+    // segments and interpolations are buffered, so that FormatStringBegin can be emitted 
+    // with the final literal length once the whole format string is consumed
+    std::vector<Token> format_string_tokens {};
+
+    u64 literal_segments_length = 0;
+    std::string segment {};
+    auto flush_segment = [&]() {
+        if(segment.empty())
+            return;
+        literal_segments_length += segment.length();
+        format_string_tokens.push_back(Token { TokenType::StringLiteral, std::move(segment) });
+        segment = {};
+    };
+
+    while(!input_stream.eos()) {
+        auto current = *input_stream.peek();
+        if(current == '"')
+            break;
+
+        auto next = input_stream.peek(1);
+        if((current == '{' || current == '}') && next != nullptr && *next == current) {
+            segment += current;
+            input_stream.consume_unchecked(); // consume first brace
+            input_stream.consume_unchecked(); // consume second brace
+            continue;
+        }
+
+        if(current == '}') {
+            result_tokens.push_back(Token { TokenType::Invalid, "unmatched '}' found in format string literal, use '}}' for a literal brace" });
+            return;
+        }
+
+        if(current != '{') {
+            segment += current;
+            input_stream.consume_unchecked();
+            continue;
+        }
+
+        // find the end of interpolated expression, skipping nested braces and string literals
+        flush_segment();
+        input_stream.consume_unchecked(); // consume '{'
+        auto expression_begin = input_stream.position();
+        usz nested_brace_depth = 0;
+        bool inside_string = false;
+        while(!input_stream.eos()) {
+            auto expression_character = *input_stream.peek();
+            if(inside_string) {
+                if(expression_character == '"')
+                    inside_string = false;
+            } else if(expression_character == '"') {
+                inside_string = true;
+            } else if(expression_character == '/' && input_stream.peek(1) != nullptr && *input_stream.peek(1) == '/') {
+                // the comment would silently swallow the rest of the interpolated expression
+                result_tokens.push_back(Token { TokenType::Invalid, "comments are not allowed inside of format string interpolation" });
+                return;
+            } else if(expression_character == '{') {
+                nested_brace_depth++;
+            } else if(expression_character == '}') {
+                if(nested_brace_depth == 0)
+                    break;
+                nested_brace_depth--;
+            }
+            input_stream.consume_unchecked();
+        }
+
+        if(input_stream.eos())
+            break;
+        auto expression_end = input_stream.position();
+        input_stream.consume_unchecked(); // consume '}'
+
+        auto expression_result = tokenize_chunk(input_stream.string(), expression_begin, expression_end, expression_end);
+        if(expression_result.error_message.has_value()) {
+            result_tokens.push_back(Token { TokenType::Invalid, std::move(*expression_result.error_message) });
+            return;
+        }
+        if(expression_result.tokens.empty()) {
+            result_tokens.push_back(Token { TokenType::Invalid, "empty interpolation found in format string literal" });
+            return;
+        }
+
+        format_string_tokens.push_back(Token { TokenType::FormatStringInterpolationBegin });
+        std::move(expression_result.tokens.begin(), expression_result.tokens.end(), std::back_inserter(format_string_tokens));
+        format_string_tokens.push_back(Token { TokenType::FormatStringInterpolationEnd });
+    }
+
+    if(input_stream.eos()) {
+        result_tokens.push_back(Token { TokenType::Invalid, "could not consume format string literal, unexpected end of file reached" });
+        return;
+    }
+    input_stream.consume_unchecked(); // consume closing '"'
+
+    flush_segment();
+    result_tokens.push_back(Token { TokenType::FormatStringBegin, literal_segments_length });
+    std::move(format_string_tokens.begin(), format_string_tokens.end(), std::back_inserter(result_tokens));
+    result_tokens.push_back(Token { TokenType::FormatStringEnd });
+}
+
 Token Tokenizer::consume_symbolic_token_or_comment(InputStream& input_stream) {
     c8 first_character = input_stream.consume_unchecked();
     switch(first_character) {
@@ -9,7 +9,7 @@ namespace slof {
 
 class Tokenizer {
 public:
-    class TokenStream : public Stream<Token> {
+    class TokenStream final : public Stream<Token> {
     public:
         explicit TokenStream(std::vector<Token> tokens) : m_tokens(std::move(tokens)) {}
 
@@ -45,13 +45,26 @@ public:
     };
 
     static TokenizationResult tokenize(std::string text_to_tokenize);
+    // splits the input at new line boundaries and lexes the chunks on separate threads, assuming
+    // that no chunk starts inside of a string literal; chunks for which this assumption turns out
+    // to be wrong are lexed again, so the result is always identical to the one of tokenize()
+    static TokenizationResult tokenize_parallel(const std::string& text_to_tokenize, usz thread_count);
 
 private:
     using consume_predicate = std::function<bool(c8)>;
 
-    class InputStream : public Stream<c8> {
+    // inputs smaller than this per thread are not worth splitting
+    static constexpr usz s_minimal_parallel_chunk_size = 64 * 1024;
+    // upper bound for the number of threads started by tokenize_parallel()
+    static constexpr usz s_maximal_parallel_thread_count = 64;
+
+    class InputStream final : public Stream<c8> {
     public:
-        explicit InputStream(const std::string& string) : m_string(string) {};
+        explicit InputStream(const std::string& string) : m_string(string), m_end(string.length()) {};
+        InputStream(const std::string& string, usz begin, usz end) : m_string(string), m_end(end), m_stream_position(begin) {};
+
+        usz position() const { return m_stream_position; }
+        const std::string& string() const { return m_string; }
 
         // ^Stream<c8>
         virtual bool eos() const override;
@@ -64,15 +77,26 @@ private:
 
     private:
         const std::string& m_string;
+        usz m_end { 0 };
         usz m_stream_position { 0 };
 
     };
 
+    struct ChunkTokenizationResult {
+        std::vector<Token> tokens {};
+        usz end_position { 0 };
+        std::optional<std::string> error_message {};
+    };
+
+    // tokenizes text[begin, end) and stops at the first token boundary at or after stop_at
+    static ChunkTokenizationResult tokenize_chunk(const std::string& text, usz begin, usz end, usz stop_at);
+
     static std::string consume_until(consume_predicate predicate, InputStream& input_stream);
 
     static Token consume_identifier_or_keyword(InputStream& input_stream);
     static Token consume_number(InputStream& input_stream);
     static Token consume_string(InputStream& input_stream);
+    static void consume_format_string(InputStream& input_stream, std::vector<Token>& result_tokens);
     static Token consume_symbolic_token_or_comment(InputStream& input_stream);
 
 };